@@ -11,11 +11,10 @@ def ngon(center, radius, segments):
 data = list()
 
 for n in range(3, 360):
-    polygons = [
-        ngon((0, 0), 1.0, n)
-    ]
+    vertices = ngon((0, 0), 1.0, n)
 
-    faces = tessellate(polygons)
+    # the array is passed directly, the loop starts at vertex 0
+    faces = tessellate(vertices, [0])
     points = integration_points(faces, 2)
     area = integrate(lambda u, v: 1, points)
 
@@ -0,0 +1,43 @@
+from NIntegrate import *
+import numpy as np
+
+# linear hat functions in x-direction on n elements
+n = 100
+
+def local_mass_matrix(x, y):
+    i = min(int(x * n), n - 1)
+    t = x * n - i
+
+    shape_functions = np.array([1 - t, t])
+
+    # active indices and the dense block for these indices
+    return [i, i + 1], np.outer(shape_functions, shape_functions)
+
+# one rectangle per element, so the integration points do not cross the
+# element boundaries
+faces = [[(i / n, 0), ((i + 1) / n, 0), ((i + 1) / n, 1), (i / n, 1)] for i in range(n)]
+
+# assemble the sparse mass matrix (scipy.sparse). the product of two linear
+# functions is exact with 2 points per direction.
+mass_matrix = integrate_sparse(local_mass_matrix, faces, 2, n + 1)
+
+print('nonzeros =', mass_matrix.nnz, flush=True)
+print('sum      =', mass_matrix.sum(), flush=True)
+
+h = 1 / n
+
+# tridiagonal: the diagonal and the two side diagonals
+assert mass_matrix.nnz == 3 * (n + 1) - 2
+
+assert abs(mass_matrix[0, 0] - h / 3) < 10e-10
+assert abs(mass_matrix[n, n] - h / 3) < 10e-10
+
+for i in range(1, n):
+    assert abs(mass_matrix[i, i] - 2 * h / 3) < 10e-10
+
+for i in range(n):
+    assert abs(mass_matrix[i, i + 1] - h / 6) < 10e-10
+    assert abs(mass_matrix[i + 1, i] - h / 6) < 10e-10
+
+# the shape functions are a partition of unity
+assert abs(mass_matrix.sum() - 1) < 10e-6
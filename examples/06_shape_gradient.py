@@ -0,0 +1,38 @@
+from NIntegrate import *
+import numpy as np
+
+# define integration domain
+polygons = [[(0.0, 2.0),
+             (0.0, 1.0),
+             (1.0, 1.0),
+             (1.0, 0.0),
+             (2.0, 0.0),
+             (2.0, 2.0)],
+            [(1.0, 1.8),
+             (1.8, 1.0),
+             (1.8, 1.8)]]
+
+function = lambda u, v: 1 + u**2 + 0.5 * u * v
+
+# integral and its derivatives with respect to all vertices
+value, gradient = integrate_with_gradient(function, polygons, 6)
+
+print('value    =', value, flush=True)
+print('gradient =', gradient, flush=True)
+
+# compare with finite differences
+vertices = [(i, j) for i, polygon in enumerate(polygons) for j in range(len(polygon))]
+
+for row, (i, j) in enumerate(vertices):
+    for k in range(2):
+        h = 1e-6
+
+        perturbed = [[list(point) for point in polygon] for polygon in polygons]
+
+        perturbed[i][j][k] += h
+        value_plus = integrate(function, tessellate(perturbed), 6)
+
+        perturbed[i][j][k] -= 2 * h
+        value_minus = integrate(function, tessellate(perturbed), 6)
+
+        assert abs(gradient[row, k] - (value_plus - value_minus) / (2 * h)) < 10e-6
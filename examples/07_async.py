@@ -0,0 +1,35 @@
+from NIntegrate import *
+import asyncio
+import numpy as np
+
+def ngon(center, radius, segments):
+    alpha = np.linspace(0, 2 * np.pi, segments, False)
+    x = np.cos(alpha)
+    y = np.sin(alpha)
+    return center + radius * np.array([x, y]).T
+
+set_thread_count(4)
+
+async def area(n):
+    # the geometry is prepared by the worker threads while the interpreter
+    # evaluates the other domains
+    faces = await asyncio.wrap_future(submit_tessellate([ngon((0, 0), 1.0, n)]))
+    u, v, weights = await asyncio.wrap_future(submit_points(faces, 2))
+
+    return np.sum(weights)
+
+async def main():
+    return await asyncio.gather(*[area(n) for n in range(3, 100)])
+
+areas = asyncio.get_event_loop().run_until_complete(main())
+
+print(areas[-1], flush=True)
+
+n = 99
+expected_area = 0.5 * n * np.sin(2 * np.pi / n)
+assert abs(areas[-1] - expected_area) < 10e-6
+
+# futures can also be used without asyncio. result() waits for the job.
+future = submit_integrate(lambda u, v: 1, tessellate([ngon((0, 0), 1.0, n)]), 2)
+
+assert abs(future.result() - expected_area) < 10e-6
@@ -0,0 +1,76 @@
+from NIntegrate import *
+import numpy as np
+import os
+import tempfile
+
+# define integration domain
+polygons = [[(0.0, 2.0),
+             (0.0, 1.0),
+             (1.0, 1.0),
+             (1.0, 0.0),
+             (2.0, 0.0),
+             (2.0, 2.0)],
+            [(1.0, 1.8),
+             (1.8, 1.0),
+             (1.8, 1.8)]]
+
+faces = tessellate(polygons)
+points = integration_points(faces, 4)
+
+directory = tempfile.mkdtemp()
+path = os.path.join(directory, 'domain.bin')
+
+# write the faces and the points
+save(path, faces, points)
+
+# the arrays are read-only views into the mapped file
+data = load(path)
+
+print('vertices =', len(data.vertices), flush=True)
+print('faces    =', len(data.face_offsets) - 1, flush=True)
+print('points   =', len(data.weights), flush=True)
+
+assert not data.weights.flags.writeable
+
+# the faces reference the shared vertices
+offsets = data.face_offsets
+indices = data.face_indices
+
+assert len(offsets) == len(faces) + 1
+
+for i, face in enumerate(faces):
+    loaded_face = data.vertices[indices[offsets[i]:offsets[i + 1]]]
+
+    assert np.array_equal(loaded_face, np.asarray(face))
+
+assert np.array_equal(data.u, [location[0] for location, _ in points])
+assert np.array_equal(data.v, [location[1] for location, _ in points])
+assert np.array_equal(data.weights, [weight for _, weight in points])
+
+# the views can be used directly
+area = np.sum(data.weights)
+
+assert abs(area - (3 - 0.8**2 / 2)) < 10e-6
+
+# the views keep the file mapped
+del data, offsets, indices
+
+# a truncated file is rejected
+with open(path, 'rb') as file:
+    content = file.read()
+
+truncated_path = os.path.join(directory, 'truncated.bin')
+
+with open(truncated_path, 'wb') as file:
+    file.write(content[:len(content) // 2])
+
+try:
+    load(truncated_path)
+except RuntimeError as error:
+    print('error    =', error, flush=True)
+else:
+    assert False, 'the truncated file was loaded'
+
+os.remove(path)
+os.remove(truncated_path)
+os.rmdir(directory)
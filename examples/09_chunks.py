@@ -0,0 +1,46 @@
+from NIntegrate import *
+import numpy as np
+
+def ngon(center, radius, segments):
+    alpha = np.linspace(0, 2 * np.pi, segments, False)
+    x = np.cos(alpha)
+    y = np.sin(alpha)
+    return center + radius * np.array([x, y]).T
+
+n = 200
+
+faces = tessellate([ngon((0, 0), 1.0, n)])
+
+expected_area = 0.5 * n * np.sin(2 * np.pi / n)
+
+chunk_size = 100
+
+# the points are generated chunk by chunk, only one chunk is kept in memory
+area = 0
+nb_points = 0
+
+for u, v, weights in integration_point_chunks(faces, 4, chunk_size):
+    assert len(u) == len(v) == len(weights) <= chunk_size
+
+    area += np.sum(weights)
+    nb_points += len(weights)
+
+print('area   =', area, flush=True)
+print('points =', nb_points, flush=True)
+
+assert abs(area - expected_area) < 10e-6
+assert nb_points == len(integration_points(faces, 4))
+
+# with overlap=True the next chunk is generated on a separate thread while
+# the callback processes the current one
+for overlap in [True, False]:
+    chunk_areas = []
+
+    def callback(u, v, weights):
+        assert len(u) == len(v) == len(weights) <= chunk_size
+
+        chunk_areas.append(np.sum(weights))
+
+    for_each_chunk(faces, 4, chunk_size, callback, overlap=overlap)
+
+    assert abs(sum(chunk_areas) - expected_area) < 10e-6
@@ -0,0 +1,66 @@
+from NIntegrate import *
+import numpy as np
+
+def ngon(center, radius, segments):
+    alpha = np.linspace(0, 2 * np.pi, segments, False)
+    x = np.cos(alpha)
+    y = np.sin(alpha)
+    return center + radius * np.array([x, y]).T
+
+# the tessellator keeps its buffers between the calls, so many domains can be
+# tessellated without allocating new memory each time
+tessellator = Tessellator()
+
+for n in range(3, 100):
+    faces = tessellator.tessellate([ngon((0, 0), 1.0, n)])
+    area = integrate(lambda u, v: 1, faces, 2)
+
+    assert abs(area - 0.5 * n * np.sin(2 * np.pi / n)) < 10e-6
+
+# the same instance handles domains with holes
+faces = tessellator.tessellate([[(0.0, 2.0),
+                                 (0.0, 1.0),
+                                 (1.0, 1.0),
+                                 (1.0, 0.0),
+                                 (2.0, 0.0),
+                                 (2.0, 2.0)],
+                                [(1.0, 1.8),
+                                 (1.8, 1.0),
+                                 (1.8, 1.8)]])
+
+area = integrate(lambda u, v: 1, faces, 2)
+
+print(area, flush=True)
+
+assert abs(area - (3 - 0.8**2 / 2)) < 10e-6
+
+# the loops are classified before tessellating. rectangles, convex and simple
+# loops are split directly, only the general case is passed to GLU.
+rectangle = [[(0, 0), (2, 0), (2, 1), (0, 1)]]
+
+faces = tessellator.tessellate(rectangle)
+
+assert classify(rectangle) == PathType.Rectangle
+assert tessellator.type == PathType.Rectangle
+assert len(faces) == 1
+
+convex = [ngon((0, 0), 1.0, 12)]
+
+tessellator.tessellate(convex)
+
+assert classify(convex) == PathType.Convex
+assert tessellator.type == PathType.Convex
+
+l_shape = [[(0, 2), (0, 1), (1, 1), (1, 0), (2, 0), (2, 2)]]
+
+tessellator.tessellate(l_shape)
+
+assert classify(l_shape) == PathType.Simple
+assert tessellator.type == PathType.Simple
+
+with_hole = [ngon((0, 0), 2.0, 12), ngon((0, 0), 0.5, 6)]
+
+tessellator.tessellate(with_hole)
+
+assert classify(with_hole) == PathType.General
+assert tessellator.type == PathType.General
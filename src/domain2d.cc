@@ -1,12 +1,20 @@
 #include "domain2d.h"
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 #include <Eigen/LU>
 
 #include "domain1d.h"
 
 #if _WIN32
+    #define NOMINMAX
     #include <windows.h>
     #include <GL/gl.h> 
     #include <GL/glu.h>
@@ -24,23 +32,54 @@ using Matrix = Eigen::MatrixXd;
 using domain2d::Point;
 using domain2d::Face;
 using domain2d::Faces;
+using domain2d::Path;
+using domain2d::PathType;
+
+struct Vertex {
+    GLdouble coordinates[3];
+};
+
+double crossZ(const Point &a, const Point &b);
 
 class MeshBuilder {
     std::vector<Point> m_buffer;
     Faces m_faces;
+    Faces m_spareFaces;
+    std::deque<Vertex> m_combinedVertices;
+    std::size_t m_nbFaces;
     GLenum m_type;
 
-    void addTriangle(const int &ia, const int &ib, const int &ic) {
-        Face face(3);
-        face[0] = m_buffer[ia];
-        face[1] = m_buffer[ib];
-        face[2] = m_buffer[ic];
+    Face &nextFace(const int &size) {
+        // faces of previous runs are reused to avoid allocations
+
+        if (m_nbFaces == m_faces.size()) {
+            if (m_spareFaces.empty()) {
+                m_faces.emplace_back();
+                m_faces.back().reserve(4);
+            } else {
+                m_faces.push_back(std::move(m_spareFaces.back()));
+                m_spareFaces.pop_back();
+            }
+        }
 
-        m_faces.push_back(face);
+        Face &face = m_faces[m_nbFaces++];
+        face.resize(size);
+
+        return face;
     }
 
-    double crossZ(const Point &a, const Point &b) const {
-        return a(0) * b(1) - a(1) * b(0);
+    void addTriangle(const int &ia, const int &ib, const int &ic) {
+        const auto &a = m_buffer[ia];
+        const auto &b = m_buffer[ib];
+        const auto &c = m_buffer[ic];
+
+        // the winding alternates in strips. the faces are stored
+        // counterclockwise to get positive weights.
+
+        Face &face = nextFace(3);
+        face[0] = a;
+        face[1] = crossZ(b - a, c - a) < 0.0 ? c : b;
+        face[2] = crossZ(b - a, c - a) < 0.0 ? b : c;
     }
 
     bool tryAddQuad(const int &ia, const int &ib, const int &ic, const int &id) {
@@ -65,15 +104,15 @@ class MeshBuilder {
         if (bcd * cda < 0.0) return false;
         if (cda * dab < 0.0) return false;
         
-        // add quad
+        // add quad (counterclockwise)
+
+        bool clockwise {crossZ(c - a, d - b) < 0.0};
 
-        Face face(4);
+        Face &face = nextFace(4);
         face[0] = a;
-        face[1] = b;
+        face[1] = clockwise ? d : b;
         face[2] = c;
-        face[3] = d;
-
-        m_faces.push_back(face);
+        face[3] = clockwise ? b : d;
 
         return true;
     }
@@ -169,10 +208,49 @@ class MeshBuilder {
     }
 
 public:
-    Faces faces() {
+    MeshBuilder() : m_nbFaces(0) {
+    }
+
+    void clear() {
+        m_nbFaces = 0;
+        m_combinedVertices.clear();
+    }
+
+    Vertex *combine(const GLdouble coordinates[3]) {
+        // vertices created by GLU at intersections. the deque keeps the
+        // addresses valid until the end of the polygon.
+
+        m_combinedVertices.push_back({{coordinates[0], coordinates[1], 0.0}});
+
+        return &m_combinedVertices.back();
+    }
+
+    const Faces &faces() {
+        // unused faces are kept with their memory for the next run
+
+        while (m_faces.size() > m_nbFaces) {
+            m_spareFaces.push_back(std::move(m_faces.back()));
+            m_faces.pop_back();
+        }
+
         return m_faces;
     }
 
+    void addFace(const Point &a, const Point &b, const Point &c) {
+        Face &face = nextFace(3);
+        face[0] = a;
+        face[1] = b;
+        face[2] = c;
+    }
+
+    void addFace(const Point &a, const Point &b, const Point &c, const Point &d) {
+        Face &face = nextFace(4);
+        face[0] = a;
+        face[1] = b;
+        face[2] = c;
+        face[3] = d;
+    }
+
     void begin(const GLenum &type) {
         m_type = type;
     }
@@ -213,7 +291,9 @@ void CALLBACK onTessBeginData(GLenum type, void *polygonData) {
 void CALLBACK onTessVertexData(void *vertexData, void *polygonData) {
     auto builder = (MeshBuilder *)(polygonData);
 
-    builder->vertex(*(Point *)vertexData);
+    auto vertex = (Vertex *)(vertexData);
+
+    builder->vertex(Point(vertex->coordinates[0], vertex->coordinates[1]));
 }
 
 void CALLBACK onTessEndData(void *polygonData) {
@@ -222,42 +302,470 @@ void CALLBACK onTessEndData(void *polygonData) {
     builder->end();
 }
 
+void CALLBACK onTessCombineData(GLdouble coords[3], void *[4], GLfloat [4], void **outData, void *polygonData) {
+    auto builder = (MeshBuilder *)(polygonData);
+
+    *outData = builder->combine(coords);
+}
+
+double crossZ(const Point &a, const Point &b) {
+    return a(0) * b(1) - a(1) * b(0);
+}
+
+bool segmentsIntersect(const Point &a, const Point &b, const Point &c, const Point &d) {
+    auto abc = crossZ(b - a, c - a);
+    auto abd = crossZ(b - a, d - a);
+    auto cda = crossZ(d - c, a - c);
+    auto cdb = crossZ(d - c, b - c);
+
+    if (abc * abd > 0.0 || cda * cdb > 0.0) {
+        return false;
+    }
+
+    if (abc == 0.0 && abd == 0.0) {
+        // collinear: check the overlap of the bounding boxes
+
+        return std::max(a(0), b(0)) >= std::min(c(0), d(0)) && std::max(c(0), d(0)) >= std::min(a(0), b(0)) &&
+               std::max(a(1), b(1)) >= std::min(c(1), d(1)) && std::max(c(1), d(1)) >= std::min(a(1), b(1));
+    }
+
+    return true;
+}
+
+bool isSimple(const std::vector<Point> &loop) {
+    auto n = loop.size();
+
+    for (std::size_t i = 0; i < n; i++) {
+        for (std::size_t j = i + 2; j < n; j++) {
+            if (i == 0 && j == n - 1) {
+                continue; // adjacent
+            }
+
+            if (segmentsIntersect(loop[i], loop[(i + 1) % n], loop[j], loop[(j + 1) % n])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+PathType classifyLoop(std::vector<Point> &loop) {
+    // removes duplicate and collinear vertices and orients the loop
+    // counterclockwise. the loop can then be tessellated directly if the
+    // result is not PathType::General.
+
+    const double tolerance {1e-12};
+    const double pi {3.14159265358979323846};
+
+    if (loop.size() > 1 && loop.front() == loop.back()) {
+        loop.pop_back();
+    }
+
+    loop.erase(std::unique(loop.begin(), loop.end()), loop.end());
+
+    bool removed {true};
+
+    while (removed && loop.size() >= 3) {
+        removed = false;
+
+        for (std::size_t i = 0; i < loop.size() && loop.size() >= 3; i++) {
+            const auto &a = loop[(i + loop.size() - 1) % loop.size()];
+            const auto &b = loop[i];
+            const auto &c = loop[(i + 1) % loop.size()];
+
+            auto ab = b - a;
+            auto bc = c - b;
+
+            if (std::abs(crossZ(ab, bc)) <= tolerance * ab.norm() * bc.norm() && ab.dot(bc) > 0.0) {
+                loop.erase(loop.begin() + i);
+                removed = true;
+            }
+        }
+    }
+
+    if (loop.size() < 3) {
+        return PathType::General;
+    }
+
+    double area {0.0};
+
+    for (std::size_t i = 0; i < loop.size(); i++) {
+        area += crossZ(loop[i], loop[(i + 1) % loop.size()]);
+    }
+
+    if (area == 0.0) {
+        return PathType::General;
+    }
+
+    if (area < 0.0) {
+        std::reverse(loop.begin(), loop.end());
+    }
+
+    // convex: all turns to the left and exactly one revolution
+
+    bool convex {true};
+    bool rectangular {loop.size() == 4};
+    double angle {0.0};
+
+    for (std::size_t i = 0; i < loop.size(); i++) {
+        auto ab = loop[(i + 1) % loop.size()] - loop[i];
+        auto bc = loop[(i + 2) % loop.size()] - loop[(i + 1) % loop.size()];
+
+        auto cross = crossZ(ab, bc);
+        auto dot = ab.dot(bc);
+
+        convex = convex && cross > 0.0;
+        rectangular = rectangular && std::abs(dot) <= tolerance * ab.norm() * bc.norm();
+
+        angle += std::atan2(cross, dot);
+    }
+
+    if (convex && std::abs(angle) < 3.0 * pi) {
+        return rectangular ? PathType::Rectangle : PathType::Convex;
+    }
+
+    if (loop.size() <= 64 && isSimple(loop)) {
+        return PathType::Simple;
+    }
+
+    return PathType::General;
+}
+
+void addConvex(MeshBuilder &builder, const std::vector<Point> &loop) {
+    // quad dominant fan around the first vertex
+
+    std::size_t i {1};
+
+    for (; i + 2 < loop.size(); i += 2) {
+        builder.addFace(loop[0], loop[i], loop[i + 1], loop[i + 2]);
+    }
+
+    if (i + 1 < loop.size()) {
+        builder.addFace(loop[0], loop[i], loop[i + 1]);
+    }
+}
+
+bool isInsideTriangle(const Point &p, const Point &a, const Point &b, const Point &c) {
+    return crossZ(b - a, p - a) >= 0.0 && crossZ(c - b, p - b) >= 0.0 && crossZ(a - c, p - c) >= 0.0;
+}
+
+bool addEarClipping(MeshBuilder &builder, const std::vector<Point> &loop, std::vector<std::size_t> &indices) {
+    indices.resize(loop.size());
+
+    for (std::size_t i = 0; i < loop.size(); i++) {
+        indices[i] = i;
+    }
+
+    while (indices.size() > 3) {
+        bool found {false};
+
+        for (std::size_t i = 0; i < indices.size() && !found; i++) {
+            const auto &a = loop[indices[(i + indices.size() - 1) % indices.size()]];
+            const auto &b = loop[indices[i]];
+            const auto &c = loop[indices[(i + 1) % indices.size()]];
+
+            if (crossZ(b - a, c - b) <= 0.0) {
+                continue; // reflex
+            }
+
+            bool empty {true};
+
+            for (std::size_t j = 0; j < indices.size() && empty; j++) {
+                const auto &p = loop[indices[j]];
+
+                if (p == a || p == b || p == c) {
+                    continue;
+                }
+
+                empty = !isInsideTriangle(p, a, b, c);
+            }
+
+            if (!empty) {
+                continue;
+            }
+
+            builder.addFace(a, b, c);
+            indices.erase(indices.begin() + i);
+
+            found = true;
+        }
+
+        if (!found) {
+            return false;
+        }
+    }
+
+    builder.addFace(loop[indices[0]], loop[indices[1]], loop[indices[2]]);
+
+    return true;
+}
+
+bool isInsideLoop(const Point &point, const Path &loop) {
+    bool inside {false};
+
+    for (std::size_t i = 0, j = loop.size() - 1; i < loop.size(); j = i++) {
+        const auto &a = loop[i];
+        const auto &b = loop[j];
+
+        if ((a(1) > point(1)) != (b(1) > point(1)) &&
+            point(0) < (b(0) - a(0)) * (point(1) - a(1)) / (b(1) - a(1)) + a(0)) {
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+class SparseAssembler {
+    // the integrand returns the active indices and the dense block for these
+    // indices. the blocks are collected as triplets and summed up by eigen.
+    // the buffer is merged into the result from time to time, so the memory
+    // scales with the nonzeros and not with the number of points.
+
+    using SparseMatrix = domain2d::SparseMatrix;
+    using Triplet = Eigen::Triplet<double>;
+
+    const std::size_t max_triplets {1 << 20};
+
+    int m_size;
+    SparseMatrix m_result;
+    std::vector<Triplet> m_triplets;
+
+    void flush() {
+        SparseMatrix chunk(m_size, m_size);
+        chunk.setFromTriplets(m_triplets.begin(), m_triplets.end());
+
+        m_result += chunk;
+
+        m_triplets.clear();
+    }
+
+public:
+    SparseAssembler(const int &size) : m_size(size), m_result(size, size) {
+    }
+
+    void add(const domain2d::Function<domain2d::LocalMatrix> &func, const domain2d::IntegrationPoints &points) {
+        for (const auto &point : points) {
+            Point uv {point.first};
+            double weight {point.second};
+
+            domain2d::LocalMatrix local {func(uv[0], uv[1])};
+
+            const auto &indices = local.first;
+            const auto &block = local.second;
+
+            const auto nbIndices = static_cast<Eigen::Index>(indices.size());
+
+            if (block.rows() != nbIndices || block.cols() != nbIndices) {
+                throw std::runtime_error("Size of the local matrix does not match the number of indices");
+            }
+
+            for (std::size_t i = 0; i < indices.size(); i++) {
+                if (indices[i] < 0 || indices[i] >= m_size) {
+                    throw std::runtime_error("Index out of range");
+                }
+            }
+
+            for (std::size_t j = 0; j < indices.size(); j++) {
+                for (std::size_t i = 0; i < indices.size(); i++) {
+                    m_triplets.emplace_back(indices[i], indices[j], block(i, j) * weight);
+                }
+            }
+
+            if (m_triplets.size() >= max_triplets) {
+                flush();
+            }
+        }
+    }
+
+    SparseMatrix result() {
+        flush();
+
+        return m_result;
+    }
+};
+
 }
 
 namespace domain2d {
 
-Faces tessellate(const Paths &paths) {
-    auto tess = gluNewTess();
+class Tessellator::Impl {
+    GLUtesselator *m_tess;
+    MeshBuilder m_builder;
+    std::vector<Vertex> m_vertices;
+    std::vector<std::size_t> m_offsets;
+    std::vector<Point> m_loop;
+    std::vector<std::size_t> m_indices;
+    PathType m_type;
 
-    gluTessCallback(tess, GLU_TESS_BEGIN_DATA, (GLvoid (CALLBACK *)())onTessBeginData);
-    gluTessCallback(tess, GLU_TESS_VERTEX_DATA, (GLvoid (CALLBACK *)())onTessVertexData);
-    gluTessCallback(tess, GLU_TESS_END_DATA, (GLvoid (CALLBACK *)())onTessEndData);
-    
-    MeshBuilder builder;
-    
-    gluTessBeginPolygon(tess, &builder);
+    bool runDirect() {
+        // single loops which are convex or simple are tessellated without GLU
 
-    std::vector<std::unique_ptr<Point>> vertices;
+        if (m_offsets.size() != 2) {
+            return false;
+        }
 
-    for (const auto &path : paths) {
-        gluTessBeginContour(tess);
-        
-        for (const auto &point : path) {
-            vertices.push_back(std::make_unique<Point>(point));
+        m_loop.clear();
 
-            GLdouble pt[2] {point[0], point[1]};
-            
-            gluTessVertex(tess, pt, (void *)(vertices.back().get()));
+        for (const auto &vertex : m_vertices) {
+            m_loop.emplace_back(vertex.coordinates[0], vertex.coordinates[1]);
+        }
+
+        m_type = classifyLoop(m_loop);
+
+        switch (m_type) {
+            case PathType::Rectangle:
+            case PathType::Convex:
+                addConvex(m_builder, m_loop);
+                return true;
+            case PathType::Simple:
+                if (addEarClipping(m_builder, m_loop, m_indices)) {
+                    return true;
+                }
+                m_builder.clear();
+                m_type = PathType::General;
+                return false;
+            default:
+                return false;
+        }
+    }
+
+public:
+    Impl() : m_tess(gluNewTess()), m_type(PathType::General) {
+        if (m_tess == nullptr) {
+            throw std::runtime_error("Could not create tessellator");
+        }
+
+        gluTessCallback(m_tess, GLU_TESS_BEGIN_DATA, (GLvoid (CALLBACK *)())onTessBeginData);
+        gluTessCallback(m_tess, GLU_TESS_VERTEX_DATA, (GLvoid (CALLBACK *)())onTessVertexData);
+        gluTessCallback(m_tess, GLU_TESS_END_DATA, (GLvoid (CALLBACK *)())onTessEndData);
+        gluTessCallback(m_tess, GLU_TESS_COMBINE_DATA, (GLvoid (CALLBACK *)())onTessCombineData);
+    }
+
+    ~Impl() {
+        gluDeleteTess(m_tess);
+    }
+
+    void load(const Paths &paths) {
+        // the vertices are stored in one buffer. it is filled completely
+        // before passing it to GLU, so the vertex pointers stay valid.
+
+        m_vertices.clear();
+        m_offsets.clear();
+
+        m_offsets.push_back(0);
+
+        for (const auto &path : paths) {
+            for (const auto &point : path) {
+                m_vertices.push_back({{point[0], point[1], 0.0}});
+            }
+
+            m_offsets.push_back(m_vertices.size());
+        }
+    }
+
+    void load(const std::vector<PathBuffer> &paths) {
+        m_vertices.clear();
+        m_offsets.clear();
+
+        m_offsets.push_back(0);
+
+        for (const auto &path : paths) {
+            for (std::size_t i = 0; i < path.size; i++) {
+                m_vertices.push_back({{path.data[2 * i], path.data[2 * i + 1], 0.0}});
+            }
+
+            m_offsets.push_back(m_vertices.size());
         }
+    }
 
-        gluTessEndContour(tess);
+    PathType type() const {
+        return m_type;
     }
 
-    gluTessEndPolygon(tess);
+    const Faces &run() {
+        m_builder.clear();
+
+        m_type = PathType::General;
 
-    gluDeleteTess(tess);
+        if (runDirect()) {
+            return m_builder.faces();
+        }
+
+        gluTessBeginPolygon(m_tess, &m_builder);
+
+        for (std::size_t i = 1; i < m_offsets.size(); i++) {
+            gluTessBeginContour(m_tess);
+
+            for (auto j = m_offsets[i - 1]; j < m_offsets[i]; j++) {
+                auto &vertex = m_vertices[j];
+
+                gluTessVertex(m_tess, vertex.coordinates, (void *)(&vertex));
+            }
 
-    return builder.faces();
+            gluTessEndContour(m_tess);
+        }
+
+        gluTessEndPolygon(m_tess);
+
+        return m_builder.faces();
+    }
+};
+
+Tessellator::Tessellator() : m_impl(new Impl()) {
+}
+
+Tessellator::~Tessellator() = default;
+
+const Faces &Tessellator::tessellate(const Paths &paths) {
+    m_impl->load(paths);
+
+    return m_impl->run();
+}
+
+const Faces &Tessellator::tessellate(const std::vector<PathBuffer> &paths) {
+    m_impl->load(paths);
+
+    return m_impl->run();
+}
+
+const Faces &Tessellator::tessellate(const double *vertices, const std::size_t &nbVertices, const std::vector<std::size_t> &offsets) {
+    std::vector<PathBuffer> paths;
+    paths.reserve(offsets.size());
+
+    for (std::size_t i = 0; i < offsets.size(); i++) {
+        auto begin = offsets[i];
+        auto end = i + 1 < offsets.size() ? offsets[i + 1] : nbVertices;
+
+        if (begin > end || end > nbVertices) {
+            throw std::runtime_error("Invalid offsets");
+        }
+
+        paths.push_back({vertices + 2 * begin, end - begin});
+    }
+
+    return tessellate(paths);
+}
+
+PathType Tessellator::type() const {
+    return m_impl->type();
+}
+
+PathType classify(const Paths &paths) {
+    if (paths.size() != 1) {
+        return PathType::General;
+    }
+
+    Path loop {paths[0]};
+
+    return classifyLoop(loop);
+}
+
+Faces tessellate(const Paths &paths) {
+    Tessellator tessellator;
+
+    return tessellator.tessellate(paths);
 }
 
 const IntegrationPoints normTrianglePoints(const int &degree) {
@@ -552,27 +1060,230 @@ IntegrationPoints pointsByQuad(const Point &a, const Point &b, const Point &c, c
     return points;
 }
 
+IntegrationPoints pointsByQuad(const Point &a, const Point &b, const Point &c, const Point &d, const int &degree) {
+    return pointsByQuad(a, b, c, d, degree, degree);
+}
+
+IntegrationPoints pointsByFace(const Face &face, const int &degreeU, const int &degreeV) {
+    switch (face.size()) {
+        case 3:
+            return pointsByTriangle(face[0], face[1], face[2], std::max(degreeU, degreeV));
+        case 4:
+            return pointsByQuad(face[0], face[1], face[2], face[3], degreeU, degreeV);
+        default:
+            throw std::runtime_error("Invalid face");
+    }
+}
+
+IntegrationPoints pointsByFace(const Face &face, const int &degree) {
+    return pointsByFace(face, degree, degree);
+}
+
 IntegrationPoints pointsByFaces(const Faces &faces, const int &degree) {
     IntegrationPoints integration_points;
     
-    for (const auto face : faces) {
-        IntegrationPoints points_face;
-        
+    for (const auto &face : faces) {
+        IntegrationPoints points_face {pointsByFace(face, degree)};
+
+        integration_points.insert(integration_points.end(), points_face.begin(), points_face.end());
+    }
+    
+    return integration_points;
+}
+
+IntegrationPoints pointsByFaces(const Faces &faces, const std::vector<int> &degrees) {
+    return pointsByFaces(faces, degrees, degrees);
+}
+
+IntegrationPoints pointsByFaces(const Faces &faces, const std::vector<int> &degreesU, const std::vector<int> &degreesV) {
+    if (degreesU.size() != faces.size() || degreesV.size() != faces.size()) {
+        throw std::runtime_error("Number of degrees does not match the number of faces");
+    }
+
+    IntegrationPoints integration_points;
+
+    for (std::size_t i = 0; i < faces.size(); i++) {
+        IntegrationPoints points_face {pointsByFace(faces[i], degreesU[i], degreesV[i])};
+
+        integration_points.insert(integration_points.end(), points_face.begin(), points_face.end());
+    }
+
+    return integration_points;
+}
+
+Degrees adaptiveDegrees(const Faces &faces, const int &degree, const int &minDegree) {
+    // the size of a face is measured along the parametric directions. for
+    // triangles the height over the longest edge is used, so thin slivers
+    // count as small. each halving of the size compared to the largest face
+    // reduces the degree by one.
+
+    std::vector<double> sizesU(faces.size());
+    std::vector<double> sizesV(faces.size());
+
+    double maxSize {0.0};
+
+    for (std::size_t i = 0; i < faces.size(); i++) {
+        const auto &face = faces[i];
+
         switch (face.size()) {
-            case 3:
-                points_face = pointsByTriangle(face[0], face[1], face[2], degree);
+            case 3: {
+                double longestEdge {std::max({(face[1] - face[0]).norm(), (face[2] - face[1]).norm(), (face[0] - face[2]).norm()})};
+                double area {0.5 * std::abs(crossZ(face[1] - face[0], face[2] - face[0]))};
+
+                sizesU[i] = longestEdge > 0.0 ? 2.0 * area / longestEdge : 0.0;
+                sizesV[i] = sizesU[i];
                 break;
+            }
             case 4:
-                points_face = pointsByQuad(face[0], face[1], face[2], face[3], degree, degree);
+                sizesU[i] = 0.5 * ((face[1] - face[0]).norm() + (face[2] - face[3]).norm());
+                sizesV[i] = 0.5 * ((face[2] - face[1]).norm() + (face[3] - face[0]).norm());
                 break;
             default:
                 throw std::runtime_error("Invalid face");
         }
 
-        integration_points.insert(integration_points.begin(), points_face.begin(), points_face.end());
+        maxSize = std::max({maxSize, sizesU[i], sizesV[i]});
+    }
+
+    auto degreeBySize = [&](const double &size) {
+        if (size <= 0.0) {
+            return minDegree;
+        }
+
+        int reduction = static_cast<int>(std::floor(std::log2(maxSize / size)));
+
+        return std::max(minDegree, degree - reduction);
+    };
+
+    Degrees degrees;
+    degrees.first.reserve(faces.size());
+    degrees.second.reserve(faces.size());
+
+    for (std::size_t i = 0; i < faces.size(); i++) {
+        degrees.first.push_back(degreeBySize(sizesU[i]));
+        degrees.second.push_back(degreeBySize(sizesV[i]));
+    }
+
+    return degrees;
+}
+
+PointChunks::PointChunks(const Faces &faces, const int &degree, const std::size_t &chunkSize)
+    : m_faces(faces), m_degree(degree), m_chunkSize(chunkSize), m_face(0), m_pendingIndex(0) {
+    if (chunkSize == 0) {
+        throw std::runtime_error("Chunk size must be positive");
+    }
+}
+
+bool PointChunks::next(IntegrationPoints &chunk) {
+    chunk.clear();
+    chunk.reserve(m_chunkSize);
+
+    while (chunk.size() < m_chunkSize) {
+        if (m_pendingIndex == m_pending.size()) {
+            if (m_face == m_faces.size()) {
+                break;
+            }
+
+            m_pending = pointsByFace(m_faces[m_face++], m_degree);
+            m_pendingIndex = 0;
+        }
+
+        auto count = std::min(m_chunkSize - chunk.size(), m_pending.size() - m_pendingIndex);
+        auto begin = m_pending.begin() + m_pendingIndex;
+
+        chunk.insert(chunk.end(), begin, begin + count);
+
+        m_pendingIndex += count;
+    }
+
+    return !chunk.empty();
+}
+
+void forEachChunk(const Faces &faces, const int &degree, const std::size_t &chunkSize, const ChunkCallback &callback, const bool &overlap) {
+    PointChunks chunks(faces, degree, chunkSize);
+
+    if (!overlap) {
+        IntegrationPoints chunk;
+
+        while (chunks.next(chunk)) {
+            callback(chunk);
+        }
+
+        return;
+    }
+
+    // the chunks are generated by a separate thread and handed over in order.
+    // at most two chunks are buffered, so the memory stays bounded.
+
+    const std::size_t capacity {2};
+
+    std::deque<IntegrationPoints> queue;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool done {false};
+    bool cancelled {false};
+    std::exception_ptr error;
+
+    std::thread producer([&]() {
+        try {
+            IntegrationPoints chunk;
+
+            while (chunks.next(chunk)) {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return queue.size() < capacity || cancelled; });
+
+                if (cancelled) {
+                    break;
+                }
+
+                queue.push_back(std::move(chunk));
+                changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        changed.notify_all();
+    });
+
+    try {
+        while (true) {
+            IntegrationPoints chunk;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return !queue.empty() || done; });
+
+                if (queue.empty()) {
+                    break;
+                }
+
+                chunk = std::move(queue.front());
+                queue.pop_front();
+                changed.notify_all();
+            }
+
+            callback(chunk);
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+            changed.notify_all();
+        }
+
+        producer.join();
+        throw;
+    }
+
+    producer.join();
+
+    if (error) {
+        std::rethrow_exception(error);
     }
-    
-    return integration_points;
 }
 
 template<typename ReturnType>
@@ -598,9 +1309,129 @@ ReturnType integrate(const Function<ReturnType> &func, const IntegrationPoints &
 
 template<typename ReturnType>
 ReturnType integrate(const Function<ReturnType> &func, const Faces &faces, const int &degree)  {
-    IntegrationPoints points {pointsByFaces(faces, degree)};
+    // the points are generated in chunks to keep the memory bounded
+
+    PointChunks chunks(faces, degree, 4096);
+
+    IntegrationPoints points;
+    chunks.next(points);
+
+    ReturnType result {integrate(func, points)};
+
+    while (chunks.next(points)) {
+        result += integrate(func, points);
+    }
+
+    return result;
+}
+
+SparseMatrix integrateSparse(const Function<LocalMatrix> &func, const IntegrationPoints &points, const int &size) {
+    SparseAssembler assembler(size);
+
+    assembler.add(func, points);
+
+    return assembler.result();
+}
+
+SparseMatrix integrateSparse(const Function<LocalMatrix> &func, const Faces &faces, const int &degree, const int &size) {
+    // the points are generated in chunks to keep the memory bounded
+
+    SparseAssembler assembler(size);
+
+    PointChunks chunks(faces, degree, 4096);
+
+    IntegrationPoints points;
+
+    while (chunks.next(points)) {
+        assembler.add(func, points);
+    }
+
+    return assembler.result();
+}
+
+std::pair<double, Eigen::MatrixXd> integrateWithGradient(const Function<double> &func, const Paths &paths, const int &degree) {
+    // the derivative with respect to a vertex is the boundary integral of
+    // f * (V . n), where V is the velocity of the adjacent edges (linear
+    // hat function of the vertex) and n the outward normal
+
+    double value {0.0};
+
+    Faces faces {tessellate(paths)};
+
+    if (!faces.empty()) {
+        value = integrate(func, faces, degree);
+    }
+
+    std::size_t nbVertices {0};
+
+    for (const auto &path : paths) {
+        nbVertices += path.size();
+    }
+
+    Eigen::MatrixXd gradient {Eigen::MatrixXd::Zero(nbVertices, 2)};
+
+    auto norm_points = domain1d::normPoints(degree);
+
+    std::size_t offset {0};
+
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        const auto &path = paths[i];
+
+        if (path.size() < 3) {
+            offset += path.size();
+            continue;
+        }
+
+        // the domain is on the left side of an edge if the point is inside
+        // an odd number of loops (odd winding rule)
+
+        double area {0.0};
+
+        for (std::size_t j = 0; j < path.size(); j++) {
+            area += crossZ(path[j], path[(j + 1) % path.size()]);
+        }
+
+        int depth {0};
+
+        for (std::size_t j = 0; j < paths.size(); j++) {
+            if (j != i && paths[j].size() >= 3 && isInsideLoop(path[0], paths[j])) {
+                depth += 1;
+            }
+        }
+
+        bool interiorLeft {(depth + (area > 0.0 ? 1 : 0)) % 2 == 1};
+
+        for (std::size_t j = 0; j < path.size(); j++) {
+            auto ia = j;
+            auto ib = (j + 1) % path.size();
+
+            const auto &a = path[ia];
+            const auto &b = path[ib];
+
+            Point edge {b - a};
+            Point normal {edge(1), -edge(0)}; // scaled by the length
+
+            if (!interiorLeft) {
+                normal = -normal;
+            }
+
+            for (const auto &norm_point : norm_points) {
+                double t {0.5 * (1.0 + norm_point.first)};
+                double weight {0.5 * norm_point.second};
+
+                Point uv {(1.0 - t) * a + t * b};
+
+                double f {func(uv[0], uv[1]) * weight};
+
+                gradient.row(offset + ia) += (f * (1.0 - t)) * normal.transpose();
+                gradient.row(offset + ib) += (f * t) * normal.transpose();
+            }
+        }
+
+        offset += path.size();
+    }
 
-    return integrate(func, points);
+    return {value, gradient};
 }
 
 template double integrate(const Function<double> &func, const IntegrationPoints &points);
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 namespace domain2d {
     using Point = Eigen::Vector2d;
@@ -20,6 +23,49 @@ namespace domain2d {
     template<typename ReturnType>
     using Function = std::function<ReturnType(double, double)>;
 
+    using Indices = std::vector<int>;
+    using LocalMatrix = std::pair<Indices, Eigen::MatrixXd>;
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    // the way a domain is tessellated. single loops which are rectangular,
+    // convex or simple (no self intersections) are tessellated directly,
+    // everything else is passed to the GLU tessellator.
+    enum class PathType {
+        General,
+        Rectangle,
+        Convex,
+        Simple
+    };
+
+    PathType classify(const Paths &paths);
+
+    // view on the vertices of one path, stored as x0, y0, x1, y1, ...
+    struct PathBuffer {
+        const double *data;
+        std::size_t size;
+    };
+
+    class Tessellator {
+        class Impl;
+        std::unique_ptr<Impl> m_impl;
+
+    public:
+        Tessellator();
+
+        ~Tessellator();
+
+        const Faces &tessellate(const Paths &paths);
+
+        const Faces &tessellate(const std::vector<PathBuffer> &paths);
+
+        // the vertices of all paths in one buffer. path i starts at vertex
+        // offsets[i] and ends at the start of the next path.
+        const Faces &tessellate(const double *vertices, const std::size_t &nbVertices, const std::vector<std::size_t> &offsets);
+
+        // type of the last tessellated domain
+        PathType type() const;
+    };
+
     Faces tessellate(const Paths &paths);
 
     const IntegrationPoints normTrianglePoints(const int &degree);
@@ -28,11 +74,57 @@ namespace domain2d {
 
     IntegrationPoints pointsByQuad(const Point &a, const Point &b, const Point &c, const Point &d, const int &degree);
 
+    IntegrationPoints pointsByQuad(const Point &a, const Point &b, const Point &c, const Point &d, const int &degreeU, const int &degreeV);
+
+    IntegrationPoints pointsByFace(const Face &face, const int &degree);
+
+    // triangles use the maximum of both degrees
+    IntegrationPoints pointsByFace(const Face &face, const int &degreeU, const int &degreeV);
+
     IntegrationPoints pointsByFaces(const Faces &faces, const int &degree);
 
+    IntegrationPoints pointsByFaces(const Faces &faces, const std::vector<int> &degrees);
+
+    IntegrationPoints pointsByFaces(const Faces &faces, const std::vector<int> &degreesU, const std::vector<int> &degreesV);
+
+    using Degrees = std::pair<std::vector<int>, std::vector<int>>;
+
+    // degrees in u and v for each face, reduced for small and thin faces
+    Degrees adaptiveDegrees(const Faces &faces, const int &degree, const int &minDegree);
+
+    // generates the integration points of the faces in chunks of a fixed
+    // size. the faces are not copied and must outlive the object.
+    class PointChunks {
+        const Faces &m_faces;
+        int m_degree;
+        std::size_t m_chunkSize;
+        std::size_t m_face;
+        IntegrationPoints m_pending;
+        std::size_t m_pendingIndex;
+
+    public:
+        PointChunks(const Faces &faces, const int &degree, const std::size_t &chunkSize);
+
+        PointChunks(Faces &&faces, const int &degree, const std::size_t &chunkSize) = delete;
+
+        bool next(IntegrationPoints &chunk);
+    };
+
+    using ChunkCallback = std::function<void(const IntegrationPoints &)>;
+
+    void forEachChunk(const Faces &faces, const int &degree, const std::size_t &chunkSize, const ChunkCallback &callback, const bool &overlap);
+
     template<typename ReturnType>
     ReturnType integrate(const Function<ReturnType> &func, const IntegrationPoints &points);
 
     template<typename ReturnType>
     ReturnType integrate(const Function<ReturnType> &func, const Faces &faces, const int &degree);
+
+    SparseMatrix integrateSparse(const Function<LocalMatrix> &func, const IntegrationPoints &points, const int &size);
+
+    SparseMatrix integrateSparse(const Function<LocalMatrix> &func, const Faces &faces, const int &degree, const int &size);
+
+    // integral over the domain and its derivatives with respect to the
+    // vertices of the paths (one row per vertex, in the order of the paths)
+    std::pair<double, Eigen::MatrixXd> integrateWithGradient(const Function<double> &func, const Paths &paths, const int &degree);
 }
\ No newline at end of file
@@ -7,26 +7,323 @@
 
 #include "domain1d.h"
 #include "domain2d.h"
+#include "jobs.h"
+#include "storage.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
 namespace py = pybind11;
 
+namespace {
+
+template<typename T>
+py::array mappedArray(const py::object &owner, const T *data, const std::size_t &rows, const std::size_t &cols = 1) {
+    // read-only view into the mapped file. the owner keeps the mapping alive.
+
+    std::vector<std::size_t> shape {rows};
+    std::vector<std::size_t> strides {cols * sizeof(T)};
+
+    if (cols > 1) {
+        shape.push_back(cols);
+        strides.push_back(sizeof(T));
+    }
+
+    py::array_t<T> array(shape, strides, data, owner);
+    array.attr("setflags")(py::arg("write") = false);
+
+    return array;
+}
+
+py::tuple chunkArrays(const domain2d::IntegrationPoints &chunk) {
+    py::array_t<double> u(chunk.size());
+    py::array_t<double> v(chunk.size());
+    py::array_t<double> weights(chunk.size());
+
+    auto u_data = u.mutable_data();
+    auto v_data = v.mutable_data();
+    auto weights_data = weights.mutable_data();
+
+    for (std::size_t i = 0; i < chunk.size(); i++) {
+        u_data[i] = chunk[i].first[0];
+        v_data[i] = chunk[i].first[1];
+        weights_data[i] = chunk[i].second;
+    }
+
+    return py::make_tuple(u, v, weights);
+}
+
+using VertexArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+domain2d::PathBuffer pathBuffer(const VertexArray &vertices) {
+    if (vertices.size() == 0) {
+        return {vertices.data(), 0};
+    }
+
+    if (vertices.ndim() != 2 || vertices.shape(1) != 2) {
+        throw std::runtime_error("Expected an array with shape (n, 2)");
+    }
+
+    return {vertices.data(), static_cast<std::size_t>(vertices.shape(0))};
+}
+
+const domain2d::Faces &tessellateArrays(domain2d::Tessellator &tessellator, const std::vector<VertexArray> &polygons) {
+    // the vertices are read directly from the numpy buffers
+
+    std::vector<domain2d::PathBuffer> paths;
+    paths.reserve(polygons.size());
+
+    for (const auto &polygon : polygons) {
+        paths.push_back(pathBuffer(polygon));
+    }
+
+    return tessellator.tessellate(paths);
+}
+
+const domain2d::Faces &tessellateArray(domain2d::Tessellator &tessellator, const VertexArray &vertices, const std::vector<std::size_t> &offsets) {
+    auto path = pathBuffer(vertices);
+
+    return tessellator.tessellate(path.data, path.size, offsets);
+}
+
+// worker pool for the submit_* functions. it is only accessed without the
+// GIL, because the tasks need the GIL to deliver their results.
+
+std::mutex pool_mutex;
+std::unique_ptr<jobs::ThreadPool> pool;
+std::size_t pool_size {std::max(1u, std::thread::hardware_concurrency())};
+
+void setThreadCount(const std::size_t &nbThreads) {
+    if (nbThreads == 0) {
+        throw std::runtime_error("Number of threads must be positive");
+    }
+
+    // waits for the queued jobs, they need the GIL to finish
+
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    pool.reset();
+    pool_size = nbThreads;
+}
+
+std::size_t threadCount() {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    return pool_size;
+}
+
+void shutdownPool() {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(pool_mutex);
+
+    pool.reset();
+}
+
+template<typename TResult, typename TConvert>
+py::object submit(std::function<TResult()> compute, TConvert convert) {
+    // the result is delivered through a concurrent.futures.Future. it can
+    // be polled or awaited with asyncio.wrap_future.
+
+    py::object future = py::module::import("concurrent.futures").attr("Future")();
+
+    PyObject *handle = future.ptr();
+    Py_INCREF(handle);
+
+    auto task = [handle, compute, convert]() {
+        TResult result;
+        std::string error;
+
+        try {
+            result = compute();
+        } catch (const std::exception &e) {
+            error = e.what();
+        } catch (...) {
+            error = "Unknown error";
+        }
+
+        py::gil_scoped_acquire acquire;
+
+        auto future = py::reinterpret_steal<py::object>(handle);
+
+        try {
+            if (error.empty()) {
+                future.attr("set_result")(convert(result));
+            } else {
+                future.attr("set_exception")(py::reinterpret_borrow<py::object>(PyExc_RuntimeError)(error));
+            }
+        } catch (const std::exception &) {
+            // the future has been cancelled
+        }
+    };
+
+    {
+        py::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(pool_mutex);
+
+        if (!pool) {
+            pool.reset(new jobs::ThreadPool(pool_size));
+        }
+
+        pool->submit(task);
+    }
+
+    return future;
+}
+
+template<typename TResult>
+py::object submit(std::function<TResult()> compute) {
+    return submit<TResult>(compute, [](TResult &result) { return py::cast(std::move(result)); });
+}
+
+void copyArrays(const std::vector<VertexArray> &polygons, std::vector<double> &vertices, std::vector<std::size_t> &offsets) {
+    // the jobs run without the GIL, so the vertices are copied out of the
+    // numpy buffers
+
+    for (const auto &polygon : polygons) {
+        auto path = pathBuffer(polygon);
+
+        offsets.push_back(vertices.size() / 2);
+        vertices.insert(vertices.end(), path.data, path.data + 2 * path.size);
+    }
+}
+
+py::object submitTessellate(std::vector<double> vertices, std::vector<std::size_t> offsets) {
+    return submit<domain2d::Faces>([vertices, offsets]() {
+        // one tessellator per worker, so the buffers are reused
+
+        thread_local domain2d::Tessellator tessellator;
+
+        return tessellator.tessellate(vertices.data(), vertices.size() / 2, offsets);
+    });
+}
+
+class PointChunkIterator {
+    domain2d::Faces m_faces;
+    domain2d::PointChunks m_chunks;
+    domain2d::IntegrationPoints m_chunk;
+
+public:
+    PointChunkIterator(const domain2d::Faces &faces, const int &degree, const std::size_t &chunkSize)
+        : m_faces(faces), m_chunks(m_faces, degree, chunkSize) {
+    }
+
+    py::tuple next() {
+        if (!m_chunks.next(m_chunk)) {
+            throw py::stop_iteration();
+        }
+
+        return chunkArrays(m_chunk);
+    }
+};
+
+}
+
 PYBIND11_PLUGIN(NIntegrate) {
     using Vector = Eigen::VectorXd;
     using Matrix = Eigen::MatrixXd;
 
     py::module m("NIntegrate", "NIntegrate");
 
+    py::enum_<domain2d::PathType>(m, "PathType")
+        .value("General", domain2d::PathType::General)
+        .value("Rectangle", domain2d::PathType::Rectangle)
+        .value("Convex", domain2d::PathType::Convex)
+        .value("Simple", domain2d::PathType::Simple);
+
+    m.def("classify",
+        &domain2d::classify,
+        py::arg("polygons")
+    );
+
+    // the numpy overloads are registered first, otherwise lists of arrays
+    // would be converted element by element
+
+    m.def("tessellate",
+        [](const std::vector<VertexArray> &polygons) {
+            domain2d::Tessellator tessellator;
+            return domain2d::Faces(tessellateArrays(tessellator, polygons));
+        },
+        py::arg("polygons")
+    );
+
+    m.def("tessellate",
+        [](const VertexArray &vertices, const std::vector<std::size_t> &offsets) {
+            domain2d::Tessellator tessellator;
+            return domain2d::Faces(tessellateArray(tessellator, vertices, offsets));
+        },
+        py::arg("vertices"),
+        py::arg("offsets")
+    );
+
     m.def("tessellate",
         &domain2d::tessellate,
         py::arg("polygons")
     );
+
+    py::class_<domain2d::Tessellator>(m, "Tessellator")
+        .def(py::init<>())
+        .def("tessellate", &tessellateArrays, py::arg("polygons"))
+        .def("tessellate", &tessellateArray, py::arg("vertices"), py::arg("offsets"))
+        .def("tessellate", py::overload_cast<const domain2d::Paths &>(&domain2d::Tessellator::tessellate), py::arg("polygons"))
+        .def_property_readonly("type", &domain2d::Tessellator::type);
     
     m.def("integration_points",
-        &domain2d::pointsByFaces,
+        py::overload_cast<const domain2d::Faces &, const int &>(&domain2d::pointsByFaces),
         py::arg("faces"),
         py::arg("degree")
     );
 
+    m.def("integration_points",
+        py::overload_cast<const domain2d::Faces &, const std::vector<int> &>(&domain2d::pointsByFaces),
+        py::arg("faces"),
+        py::arg("degrees")
+    );
+
+    m.def("integration_points",
+        py::overload_cast<const domain2d::Faces &, const std::vector<int> &, const std::vector<int> &>(&domain2d::pointsByFaces),
+        py::arg("faces"),
+        py::arg("degrees_u"),
+        py::arg("degrees_v")
+    );
+
+    m.def("adaptive_degrees",
+        &domain2d::adaptiveDegrees,
+        py::arg("faces"),
+        py::arg("degree"),
+        py::arg("min_degree") = 1
+    );
+
+    py::class_<PointChunkIterator>(m, "PointChunkIterator")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &PointChunkIterator::next);
+
+    m.def("integration_point_chunks",
+        [](const domain2d::Faces &faces, const int &degree, const std::size_t &chunkSize) {
+            return std::unique_ptr<PointChunkIterator>(new PointChunkIterator(faces, degree, chunkSize));
+        },
+        py::arg("faces"),
+        py::arg("degree"),
+        py::arg("chunk_size")
+    );
+
+    m.def("for_each_chunk",
+        [](const domain2d::Faces &faces, const int &degree, const std::size_t &chunkSize, const py::function &callback, const bool &overlap) {
+            domain2d::forEachChunk(faces, degree, chunkSize, [&](const domain2d::IntegrationPoints &chunk) {
+                callback(*chunkArrays(chunk));
+            }, overlap);
+        },
+        py::arg("faces"),
+        py::arg("degree"),
+        py::arg("chunk_size"),
+        py::arg("callback"),
+        py::arg("overlap") = true
+    );
+
     m.def("integrate",
         py::overload_cast<const domain2d::Function<double> &, const domain2d::IntegrationPoints &>(&domain2d::integrate<double>),
         py::arg("function"),
@@ -66,5 +363,184 @@ PYBIND11_PLUGIN(NIntegrate) {
         py::arg("degree")
     );
 
+    m.def("integrate_with_gradient",
+        &domain2d::integrateWithGradient,
+        py::arg("function"),
+        py::arg("polygons"),
+        py::arg("degree")
+    );
+
+    m.def("integrate_sparse",
+        py::overload_cast<const domain2d::Function<domain2d::LocalMatrix> &, const domain2d::IntegrationPoints &, const int &>(&domain2d::integrateSparse),
+        py::arg("function"),
+        py::arg("points"),
+        py::arg("size")
+    );
+
+    m.def("integrate_sparse",
+        py::overload_cast<const domain2d::Function<domain2d::LocalMatrix> &, const domain2d::Faces &, const int &, const int &>(&domain2d::integrateSparse),
+        py::arg("function"),
+        py::arg("faces"),
+        py::arg("degree"),
+        py::arg("size")
+    );
+
+    m.def("save",
+        &storage::save,
+        py::arg("path"),
+        py::arg("faces"),
+        py::arg("points")
+    );
+
+    py::class_<storage::MappedData>(m, "MappedData")
+        .def(py::init<const std::string &>(), py::arg("path"))
+        .def_property_readonly("vertices", [](py::object self) {
+            const auto &data = self.cast<const storage::MappedData &>();
+            return mappedArray(self, data.vertices(), data.nbVertices(), 2);
+        })
+        .def_property_readonly("face_offsets", [](py::object self) {
+            const auto &data = self.cast<const storage::MappedData &>();
+            return mappedArray(self, data.faceOffsets(), data.nbFaces() + 1);
+        })
+        .def_property_readonly("face_indices", [](py::object self) {
+            const auto &data = self.cast<const storage::MappedData &>();
+            return mappedArray(self, data.faceIndices(), data.nbIndices());
+        })
+        .def_property_readonly("u", [](py::object self) {
+            const auto &data = self.cast<const storage::MappedData &>();
+            return mappedArray(self, data.u(), data.nbPoints());
+        })
+        .def_property_readonly("v", [](py::object self) {
+            const auto &data = self.cast<const storage::MappedData &>();
+            return mappedArray(self, data.v(), data.nbPoints());
+        })
+        .def_property_readonly("weights", [](py::object self) {
+            const auto &data = self.cast<const storage::MappedData &>();
+            return mappedArray(self, data.weights(), data.nbPoints());
+        })
+        .def("faces", &storage::MappedData::faces)
+        .def("points", &storage::MappedData::points);
+
+    m.def("load",
+        [](const std::string &path) { return std::unique_ptr<storage::MappedData>(new storage::MappedData(path)); },
+        py::arg("path")
+    );
+
+    m.def("set_thread_count",
+        &setThreadCount,
+        py::arg("count")
+    );
+
+    m.def("thread_count",
+        &threadCount
+    );
+
+    // the numpy overloads are registered first, see tessellate
+
+    m.def("submit_tessellate",
+        [](const std::vector<VertexArray> &polygons) {
+            std::vector<double> vertices;
+            std::vector<std::size_t> offsets;
+
+            copyArrays(polygons, vertices, offsets);
+
+            return submitTessellate(std::move(vertices), std::move(offsets));
+        },
+        py::arg("polygons")
+    );
+
+    m.def("submit_tessellate",
+        [](const VertexArray &vertices, const std::vector<std::size_t> &offsets) {
+            auto path = pathBuffer(vertices);
+
+            return submitTessellate(std::vector<double>(path.data, path.data + 2 * path.size), offsets);
+        },
+        py::arg("vertices"),
+        py::arg("offsets")
+    );
+
+    m.def("submit_tessellate",
+        [](const domain2d::Paths &polygons) {
+            return submit<domain2d::Faces>([polygons]() {
+                thread_local domain2d::Tessellator tessellator;
+
+                return tessellator.tessellate(polygons);
+            });
+        },
+        py::arg("polygons")
+    );
+
+    m.def("submit_points",
+        [](const domain2d::Faces &faces, const int &degree) {
+            // the points are returned as (u, v, weights) arrays, a list of
+            // tuples would block the interpreter for large outputs
+
+            std::function<domain2d::IntegrationPoints()> compute = [faces, degree]() {
+                return domain2d::pointsByFaces(faces, degree);
+            };
+
+            return submit<domain2d::IntegrationPoints>(compute, [](domain2d::IntegrationPoints &points) {
+                return chunkArrays(points);
+            });
+        },
+        py::arg("faces"),
+        py::arg("degree")
+    );
+
+    m.def("submit_integrate",
+        [](const py::function &function, const domain2d::Faces &faces, const int &degree) {
+            // the points are generated without the GIL. the GIL is acquired
+            // once per chunk to evaluate the function for all its points.
+            // the reference to the function is released by the task.
+
+            PyObject *handle = function.ptr();
+            Py_INCREF(handle);
+
+            return submit<double>([handle, faces, degree]() {
+                double result {0.0};
+                std::string error;
+
+                try {
+                    domain2d::PointChunks chunks(faces, degree, 4096);
+                    domain2d::IntegrationPoints chunk;
+
+                    while (error.empty() && chunks.next(chunk)) {
+                        py::gil_scoped_acquire acquire;
+
+                        try {
+                            py::handle func(handle);
+
+                            for (const auto &point : chunk) {
+                                result += func(point.first[0], point.first[1]).cast<double>() * point.second;
+                            }
+                        } catch (const std::exception &e) {
+                            error = e.what();
+                        }
+                    }
+                } catch (const std::exception &e) {
+                    error = e.what();
+                }
+
+                {
+                    py::gil_scoped_acquire acquire;
+                    Py_DECREF(handle);
+                }
+
+                if (!error.empty()) {
+                    throw std::runtime_error(error);
+                }
+
+                return result;
+            });
+        },
+        py::arg("function"),
+        py::arg("faces"),
+        py::arg("degree")
+    );
+
+    // wait for the workers before the interpreter shuts down
+
+    py::module::import("atexit").attr("register")(py::cpp_function(&shutdownPool));
+
     return m.ptr();
 }
\ No newline at end of file
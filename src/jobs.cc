@@ -0,0 +1,70 @@
+#include "jobs.h"
+
+#include <stdexcept>
+
+namespace jobs {
+
+ThreadPool::ThreadPool(const std::size_t &nbThreads) : m_stop(false) {
+    if (nbThreads == 0) {
+        throw std::runtime_error("Number of threads must be positive");
+    }
+
+    m_threads.reserve(nbThreads);
+
+    for (std::size_t i = 0; i < nbThreads; i++) {
+        m_threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_changed.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return m_threads.size();
+}
+
+void ThreadPool::submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_stop) {
+            throw std::runtime_error("Thread pool is stopped");
+        }
+
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_changed.notify_one();
+}
+
+void ThreadPool::work() {
+    while (true) {
+        Task task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [&]() { return m_stop || !m_tasks.empty(); });
+
+            if (m_tasks.empty()) {
+                return; // stopped
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+}
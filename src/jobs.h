@@ -0,0 +1,37 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jobs {
+    using Task = std::function<void()>;
+
+    class ThreadPool {
+        std::vector<std::thread> m_threads;
+        std::deque<Task> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        bool m_stop;
+
+        void work();
+
+    public:
+        explicit ThreadPool(const std::size_t &nbThreads);
+
+        // finishes the queued tasks before joining the threads
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        std::size_t size() const;
+
+        void submit(Task task);
+    };
+}
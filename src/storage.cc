@@ -0,0 +1,313 @@
+#include "storage.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#if _WIN32
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+using domain2d::Point;
+using domain2d::Face;
+using domain2d::Faces;
+using domain2d::IntegrationPoint;
+using domain2d::IntegrationPoints;
+
+const char magic[8] {'N', 'I', 'N', 'T', 'E', 'G', 'R', 'T'};
+
+const std::uint32_t byteOrder {0x01020304};
+
+const std::uint64_t alignment {64};
+
+std::uint64_t align(const std::uint64_t &offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+class Writer {
+    std::ofstream m_stream;
+    std::uint64_t m_position;
+
+public:
+    Writer(const std::string &path) : m_stream(path, std::ios::binary | std::ios::trunc), m_position(0) {
+        if (!m_stream) {
+            throw std::runtime_error("Could not open file '" + path + "'");
+        }
+    }
+
+    void write(const void *data, const std::uint64_t &size) {
+        m_stream.write(reinterpret_cast<const char *>(data), size);
+        m_position += size;
+    }
+
+    void pad() {
+        const char zeros[alignment] {};
+
+        write(zeros, align(m_position) - m_position);
+    }
+
+    void close() {
+        m_stream.close();
+
+        if (!m_stream) {
+            throw std::runtime_error("Could not write file");
+        }
+    }
+};
+
+}
+
+namespace storage {
+
+void save(const std::string &path, const Faces &faces, const IntegrationPoints &points) {
+    // flatten the faces into a mesh with shared vertices
+
+    std::map<std::pair<double, double>, std::int32_t> vertex_ids;
+
+    std::vector<double> vertices;
+    std::vector<std::int64_t> face_offsets;
+    std::vector<std::int32_t> face_indices;
+
+    face_offsets.reserve(faces.size() + 1);
+    face_offsets.push_back(0);
+
+    for (const auto &face : faces) {
+        for (const auto &vertex : face) {
+            auto key = std::make_pair(vertex[0], vertex[1]);
+            auto it = vertex_ids.emplace(key, static_cast<std::int32_t>(vertex_ids.size())).first;
+
+            if (static_cast<std::size_t>(it->second) == vertices.size() / 2) {
+                vertices.push_back(vertex[0]);
+                vertices.push_back(vertex[1]);
+            }
+
+            face_indices.push_back(it->second);
+        }
+
+        face_offsets.push_back(face_indices.size());
+    }
+
+    std::vector<double> u(points.size());
+    std::vector<double> v(points.size());
+    std::vector<double> weights(points.size());
+
+    for (std::size_t i = 0; i < points.size(); i++) {
+        u[i] = points[i].first[0];
+        v[i] = points[i].first[1];
+        weights[i] = points[i].second;
+    }
+
+    // compute the layout
+
+    Header header {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byteOrder = byteOrder;
+    header.nbVertices = vertices.size() / 2;
+    header.nbFaces = faces.size();
+    header.nbIndices = face_indices.size();
+    header.nbPoints = points.size();
+
+    const std::uint64_t sizes[6] {
+        vertices.size() * sizeof(double),
+        face_offsets.size() * sizeof(std::int64_t),
+        face_indices.size() * sizeof(std::int32_t),
+        u.size() * sizeof(double),
+        v.size() * sizeof(double),
+        weights.size() * sizeof(double)
+    };
+
+    std::uint64_t offset {align(sizeof(Header))};
+
+    for (int i = 0; i < 6; i++) {
+        header.offsets[i] = offset;
+        offset = align(offset + sizes[i]);
+    }
+
+    // write the data
+
+    Writer writer(path);
+
+    writer.write(&header, sizeof(Header));
+    writer.pad();
+
+    const void *sections[6] {
+        vertices.data(),
+        face_offsets.data(),
+        face_indices.data(),
+        u.data(),
+        v.data(),
+        weights.data()
+    };
+
+    for (int i = 0; i < 6; i++) {
+        writer.write(sections[i], sizes[i]);
+        writer.pad();
+    }
+
+    writer.close();
+}
+
+MappedData::MappedData(const std::string &path) {
+#if _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open file '" + path + "'");
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(m_file, &size)) {
+        CloseHandle(m_file);
+        throw std::runtime_error("Could not read the size of file '" + path + "'");
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+
+    m_mapping = m_size > 0 ? CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    m_data = m_mapping ? static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+    m_file = open(path.c_str(), O_RDONLY);
+
+    if (m_file == -1) {
+        throw std::runtime_error("Could not open file '" + path + "'");
+    }
+
+    struct stat info;
+
+    if (fstat(m_file, &info) != 0) {
+        close(m_file);
+        throw std::runtime_error("Could not read the size of file '" + path + "'");
+    }
+
+    m_size = static_cast<std::size_t>(info.st_size);
+
+    void *data = m_size > 0 ? mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0) : MAP_FAILED;
+    m_data = data != MAP_FAILED ? static_cast<const char *>(data) : nullptr;
+#endif
+
+    m_header = reinterpret_cast<const Header *>(m_data);
+
+    // validate the header and the sections
+
+    std::string error;
+
+    if (m_data == nullptr || m_size < sizeof(Header) || std::memcmp(m_header->magic, magic, sizeof(magic)) != 0) {
+        error = "Invalid file '" + path + "'";
+    } else if (m_header->byteOrder != byteOrder) {
+        error = "Unsupported byte order";
+    } else if (m_header->version != version) {
+        error = "Unsupported version (" + std::to_string(m_header->version) + ")";
+    } else {
+        // compare the counts with the available space, the sizes in bytes
+        // could overflow for corrupt headers
+
+        const std::uint64_t counts[6] {
+            m_header->nbVertices,
+            m_header->nbFaces,
+            m_header->nbIndices,
+            m_header->nbPoints,
+            m_header->nbPoints,
+            m_header->nbPoints
+        };
+
+        const std::uint64_t itemSizes[6] {
+            2 * sizeof(double),
+            sizeof(std::int64_t),
+            sizeof(std::int32_t),
+            sizeof(double),
+            sizeof(double),
+            sizeof(double)
+        };
+
+        for (int i = 0; i < 6; i++) {
+            auto offset = m_header->offsets[i];
+
+            if (offset % alignment != 0 || offset > m_size) {
+                error = "File '" + path + "' is truncated or corrupt";
+                break;
+            }
+
+            auto capacity = (m_size - offset) / itemSizes[i];
+
+            // the face offsets have one entry more than faces
+            bool fits {i == 1 ? counts[i] < capacity : counts[i] <= capacity};
+
+            if (!fits) {
+                error = "File '" + path + "' is truncated or corrupt";
+                break;
+            }
+        }
+    }
+
+    if (!error.empty()) {
+        unmap();
+        throw std::runtime_error(error);
+    }
+}
+
+MappedData::~MappedData() {
+    unmap();
+}
+
+void MappedData::unmap() {
+#if _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    CloseHandle(m_file);
+#else
+    if (m_data) munmap(const_cast<char *>(m_data), m_size);
+    close(m_file);
+#endif
+}
+
+Faces MappedData::faces() const {
+    auto offsets = faceOffsets();
+    auto indices = faceIndices();
+    auto xy = vertices();
+
+    Faces faces(nbFaces());
+
+    for (std::size_t i = 0; i < faces.size(); i++) {
+        if (offsets[i] < 0 || offsets[i] > offsets[i + 1] || offsets[i + 1] > static_cast<std::int64_t>(nbIndices())) {
+            throw std::runtime_error("Invalid face offsets");
+        }
+
+        auto &face = faces[i];
+
+        face.reserve(offsets[i + 1] - offsets[i]);
+
+        for (auto j = offsets[i]; j < offsets[i + 1]; j++) {
+            if (indices[j] < 0 || indices[j] >= static_cast<std::int64_t>(nbVertices())) {
+                throw std::runtime_error("Invalid face index");
+            }
+
+            face.emplace_back(xy[2 * indices[j]], xy[2 * indices[j] + 1]);
+        }
+    }
+
+    return faces;
+}
+
+IntegrationPoints MappedData::points() const {
+    IntegrationPoints points;
+    points.reserve(nbPoints());
+
+    for (std::size_t i = 0; i < nbPoints(); i++) {
+        points.emplace_back(Point(u()[i], v()[i]), weights()[i]);
+    }
+
+    return points;
+}
+
+}
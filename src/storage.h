@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "domain2d.h"
+
+namespace storage {
+    // file layout (version 1, native byte order):
+    //
+    //   header
+    //   vertices      double[2 * nbVertices]  (x0, y0, x1, y1, ...)
+    //   face offsets  int64[nbFaces + 1]      (face i = indices[offsets[i]:offsets[i + 1]])
+    //   face indices  int32[nbIndices]
+    //   u             double[nbPoints]
+    //   v             double[nbPoints]
+    //   weights       double[nbPoints]
+    //
+    // every section starts at a multiple of 64 bytes.
+
+    const std::uint32_t version = 1;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t nbVertices;
+        std::uint64_t nbFaces;
+        std::uint64_t nbIndices;
+        std::uint64_t nbPoints;
+        std::uint64_t offsets[6];
+    };
+
+    void save(const std::string &path, const domain2d::Faces &faces, const domain2d::IntegrationPoints &points);
+
+    class MappedData {
+        const char *m_data;
+        std::size_t m_size;
+        const Header *m_header;
+
+#if _WIN32
+        void *m_file;
+        void *m_mapping;
+#else
+        int m_file;
+#endif
+
+        void unmap();
+
+        template<typename T>
+        const T *section(const int &index) const {
+            return reinterpret_cast<const T *>(m_data + m_header->offsets[index]);
+        }
+
+    public:
+        explicit MappedData(const std::string &path);
+
+        ~MappedData();
+
+        MappedData(const MappedData &) = delete;
+
+        MappedData &operator=(const MappedData &) = delete;
+
+        std::size_t nbVertices() const { return m_header->nbVertices; }
+
+        std::size_t nbFaces() const { return m_header->nbFaces; }
+
+        std::size_t nbIndices() const { return m_header->nbIndices; }
+
+        std::size_t nbPoints() const { return m_header->nbPoints; }
+
+        const double *vertices() const { return section<double>(0); }
+
+        const std::int64_t *faceOffsets() const { return section<std::int64_t>(1); }
+
+        const std::int32_t *faceIndices() const { return section<std::int32_t>(2); }
+
+        const double *u() const { return section<double>(3); }
+
+        const double *v() const { return section<double>(4); }
+
+        const double *weights() const { return section<double>(5); }
+
+        domain2d::Faces faces() const;
+
+        domain2d::IntegrationPoints points() const;
+    };
+}